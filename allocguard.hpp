@@ -0,0 +1,23 @@
+/*
+*  Allocation guard for bench runs, compiled in with -DALLOC_GUARD (make CXXFLAGS=-DALLOC_GUARD).
+*  It interposes malloc & co. for the whole process, SDL and Xlib included; operator new goes
+*  through malloc as well. Once armed any allocation aborts, so a replay that finishes proves the
+*  frame loop runs allocation free after warm-up.
+*  Live sessions allocate in Xlib, use it with --replay.
+*  Without ALLOC_GUARD all of this compiles to nothing.
+*/
+#pragma once
+
+class AllocGuard
+{
+public:
+#ifdef ALLOC_GUARD
+    static void arm();
+    static void disarm();
+    static unsigned long count(); // allocations since start
+#else
+    static void arm() {}
+    static void disarm() {}
+    static unsigned long count() { return 0; }
+#endif
+};
@@ -0,0 +1,32 @@
+#include "arena.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+Arena::Arena(size_t capacity) : base_(NULL), capacity_(capacity), used_(0)
+{
+    base_ = (char*) malloc(capacity);
+
+    if (base_ == NULL)
+    {
+        fprintf(stderr, "Could not reserve %zu bytes arena\n", capacity);
+        exit(1);
+    }
+}
+
+Arena::~Arena()
+{
+    free(base_);
+}
+
+void* Arena::allocate(size_t size, size_t align)
+{
+    uintptr_t start = ((uintptr_t)(base_ + used_) + align - 1) & ~(uintptr_t)(align - 1);
+    size_t offset = start - (uintptr_t) base_;
+
+    if (offset + size > capacity_)
+        return NULL;
+
+    used_ = offset + size;
+    return base_ + offset;
+}
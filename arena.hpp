@@ -0,0 +1,40 @@
+/*
+*  Fixed-capacity arena for the per-pet objects, reserved once at startup.
+*  Objects are bump-allocated and never freed one by one, callers destroy them explicitly
+*  before the arena goes away. Nothing in the frame loop should reach malloc through here.
+*/
+#pragma once
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+class Arena
+{
+public:
+    explicit Arena(size_t capacity);
+    ~Arena();
+
+    // NULL once the capacity is used up
+    void* allocate(size_t size, size_t align);
+
+    template<class T, class... Args>
+    T* create(Args&&... args)
+    {
+        void *p = allocate(sizeof(T), alignof(T));
+        return p ? new (p) T(std::forward<Args>(args)...) : NULL;
+    }
+
+    template<class T>
+    void destroy(T *p)
+    {
+        if (p) p->~T();
+    }
+
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    char*  base_;
+    size_t capacity_;
+    size_t used_;
+};
@@ -0,0 +1,95 @@
+#include "deadlines.hpp"
+
+DeadlineQueue::DeadlineQueue(int capacity) : heap_(capacity), pos_(capacity, -1), size_(0)
+{
+}
+
+void DeadlineQueue::place(int i, const Entry &e)
+{
+    heap_[i] = e;
+    pos_[e.id] = i;
+}
+
+void DeadlineQueue::siftUp(int i)
+{
+    Entry e = heap_[i];
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!before(e.deadline, heap_[parent].deadline))
+            break;
+        place(i, heap_[parent]);
+        i = parent;
+    }
+    place(i, e);
+}
+
+void DeadlineQueue::siftDown(int i)
+{
+    Entry e = heap_[i];
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= size_)
+            break;
+        if (child + 1 < size_ && before(heap_[child + 1].deadline, heap_[child].deadline))
+            child++;
+        if (!before(heap_[child].deadline, e.deadline))
+            break;
+        place(i, heap_[child]);
+        i = child;
+    }
+    place(i, e);
+}
+
+void DeadlineQueue::removeAt(int i)
+{
+    pos_[heap_[i].id] = -1;
+    size_--;
+
+    if (i == size_)
+        return;
+
+    Entry last = heap_[size_];
+    place(i, last);
+    siftUp(i);
+    siftDown(pos_[last.id]);
+}
+
+void DeadlineQueue::schedule(int id, Uint32 deadline)
+{
+    int i = pos_[id];
+
+    if (i < 0)
+    {
+        i = size_++;
+        place(i, { deadline, id });
+        siftUp(i);
+        return;
+    }
+
+    heap_[i].deadline = deadline;
+    siftUp(i);
+    siftDown(pos_[id]);
+}
+
+int DeadlineQueue::popExpired(Uint32 now)
+{
+    if (size_ == 0 || before(now, heap_[0].deadline))
+        return -1;
+
+    int id = heap_[0].id;
+    removeAt(0);
+    return id;
+}
+
+Uint32 DeadlineQueue::timeUntil(Uint32 now, Uint32 limit) const
+{
+    if (size_ == 0)
+        return limit;
+    if (!before(now, heap_[0].deadline))
+        return 0;
+
+    Uint32 wait = heap_[0].deadline - now;
+    return wait < limit ? wait : limit;
+}
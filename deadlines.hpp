@@ -0,0 +1,44 @@
+/*
+*  Min-heap of next-transition deadlines shared by all cats.
+*  Each cat owns one slot, identified by an id in [0, capacity), so rescheduling moves the entry
+*  in place and the heap never holds stale deadlines. The frame loop pops only the expired ids and
+*  asks timeUntil how long it may sleep.
+*  Deadlines are SDL ticks in ms, compared the SDL_TICKS_PASSED way so they survive the 49 day wrap.
+*/
+#pragma once
+#include <vector>
+#include <SDL2/SDL.h>
+
+class DeadlineQueue
+{
+public:
+    // all storage is reserved here, schedule/popExpired do not allocate
+    explicit DeadlineQueue(int capacity);
+
+    // insert id or move it to its new deadline
+    void schedule(int id, Uint32 deadline);
+
+    // one id whose deadline is at or before now, removed from the queue, -1 if none
+    int popExpired(Uint32 now);
+
+    // ms from now to the earliest deadline, 0 if one already expired, limit if none is closer
+    Uint32 timeUntil(Uint32 now, Uint32 limit) const;
+
+private:
+    struct Entry
+    {
+        Uint32 deadline;
+        int    id;
+    };
+
+    static bool before(Uint32 a, Uint32 b) { return (Sint32)(a - b) < 0; }
+
+    void place(int i, const Entry &e);
+    void siftUp(int i);
+    void siftDown(int i);
+    void removeAt(int i);
+
+    std::vector<Entry> heap_;
+    std::vector<int>   pos_; // heap index per id, -1 when not queued
+    int                size_;
+};
@@ -1,6 +1,16 @@
 #include "sdlx11.hpp"
+#include "replay.hpp"
+#include "deadlines.hpp"
+#include "arena.hpp"
+#include "allocguard.hpp"
 #include <random>
-#include <chrono>
+#include <algorithm>
+#include <string.h>
+
+// per-pet objects come from a startup arena sized for this many cats
+#define MAX_CATS 1
+// frames after which the frame loop must not allocate anymore (ALLOC_GUARD builds)
+#define WARMUP_FRAMES 60
 
 enum State
 {
@@ -21,13 +31,23 @@ enum Direction
 class Cat
 {
     public:
-        Cat(SDL_Renderer *_renderer, SDL_Window* _window, SDL_DisplayMode _dm)
+        Cat(SDL_Renderer *_renderer, SDL_Window* _window, SDL_DisplayMode _dm, Uint32 seed, Uint32 now)
+            : eng(seed), distr(0, 100)
         {
             renderer = _renderer;
             window = _window;
             dm = _dm;
-            image = IMG_Load("cat.png");
-            texture = SDL_CreateTextureFromSurface(renderer, image);
+            texture = NULL;
+            texture_left = NULL;
+            SDL_Surface *image = IMG_Load("cat.png");
+            if (image == NULL) {
+                SDL_Log("IMG_Load cat.png failed: %s", SDL_GetError());
+            }
+            else {
+                texture = SDL_CreateTextureFromSurface(renderer, image);
+                texture_left = createMirroredTexture(image);
+                SDL_FreeSurface(image);
+            }
             state = State::WALK;
             direction = Direction::RIGHT;
 
@@ -35,88 +55,32 @@ class Cat
             y = dm.h - 64;
             SDL_SetWindowPosition(window, dm.w / 2, dm.h - 64);
 
-            start_action = std::chrono::steady_clock::now();
+            start_action = now;
         }
 
         ~Cat()
         {
-            SDL_DestroyTexture(texture);
-            SDL_FreeSurface(image);
+            if (texture) SDL_DestroyTexture(texture);
+            if (texture_left) SDL_DestroyTexture(texture_left);
         }
 
-        void update()
+        // false when the sprite sheet could not be loaded, the cat must not be used then
+        bool loaded()
         {
-            computeBehavior();
-            updateState();
+            return texture != NULL && texture_left != NULL;
         }
 
-        void computeBehavior()
+        // now is the frame clock in ms, the live SDL_GetTicks() or the recorded one on replay
+        void update(Uint32 now)
         {
-            std::random_device rd;
-            std::mt19937 eng(rd());
-            std::uniform_int_distribution<> distr(0, 100);
-            int randomPercent = distr(eng);
+            updateState(now);
+        }
 
-            if (state == State::IDLE) {
-                actionDuration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_action).count();
-                if (actionDuration < minimumIdleTime) {
-                    return;
-                }
-                else {
-                    actionDuration = 0;
-                    start_action = std::chrono::steady_clock::now();
-                }
-            }
-            else if (state == State::IDLE2) {
-                actionDuration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_action).count();
-                if (actionDuration < minimumIdleTime) {
-                    return;
-                }
-                else {
-                    actionDuration = 0;
-                    start_action = std::chrono::steady_clock::now();
-                }
-            }
-            else if (state == State::IDLE3) {
-                actionDuration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_action).count();
-                if (actionDuration < minimumIdleTime) {
-                    return;
-                }
-                else {
-                    actionDuration = 0;
-                    start_action = std::chrono::steady_clock::now();
-                }
-            }
-            else if (state == State::IDLE4) {
-                actionDuration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_action).count();
-                if (actionDuration < minimumIdleTime) {
-                    return;
-                }
-                else {
-                    actionDuration = 0;
-                    start_action = std::chrono::steady_clock::now();
-                }
-            }
-            else if (state == State::IDLE5) {
-                actionDuration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_action).count();
-                if (actionDuration < minimumSleepTime) {
-                    return;
-                }
-                else {
-                    actionDuration = 0;
-                    start_action = std::chrono::steady_clock::now();
-                }
-            }
-            else if (state == State::WALK) {
-                actionDuration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_action).count();
-                if (actionDuration < minimumWalkTime) {
-                    return;
-                }
-                else {
-                    actionDuration = 0;
-                    start_action = std::chrono::steady_clock::now();
-                }
-            }
+        // pick the next action, only called once deadline() has passed
+        void computeBehavior(Uint32 now)
+        {
+            int randomPercent = distr(eng);
+            start_action = now;
 
             // Vérification de la plage de pourcentage pour déterminer l'action à effectuer
             if (randomPercent < sleepPercent)
@@ -145,9 +109,9 @@ class Cat
             }
         }
 
-        void updateState()
+        void updateState(Uint32 now)
         {
-            ticks = SDL_GetTicks();
+            ticks = now;
 
             if (state == State::IDLE) {
                 sprite = (ticks / SPEED) % 4;
@@ -205,10 +169,10 @@ class Cat
         void draw()
         {
             if (direction == Direction::LEFT) {
-                SDL_RenderCopyEx(renderer, texture, &srcrect, &dstrect, 0, NULL, SDL_FLIP_HORIZONTAL);
+                SDL_RenderCopy(renderer, texture_left, &srcrect, &dstrect);
             }
             else if (direction == Direction::RIGHT) {
-                SDL_RenderCopyEx(renderer, texture, &srcrect, &dstrect, 0, NULL, SDL_FLIP_NONE);
+                SDL_RenderCopy(renderer, texture, &srcrect, &dstrect);
             }
         }
 
@@ -217,18 +181,71 @@ class Cat
             state = _state;
         }
 
+        // end of the minimum time of the current action, counted from its start
+        Uint32 deadline()
+        {
+            int minimumTime = minimumIdleTime;
+            if (state == State::IDLE5) {
+                minimumTime = minimumSleepTime;
+            }
+            else if (state == State::WALK) {
+                minimumTime = minimumWalkTime;
+            }
+            return start_action + minimumTime * 1000;
+        }
+
+        // ms until the frame would change, walking moves every frame
+        Uint32 idleFor(Uint32 now)
+        {
+            if (state == State::WALK) {
+                return 0;
+            }
+            return SPEED - now % SPEED;
+        }
+
         State getState()
         {
             return state;
         }
 
+        // cheap test of a root pointer position against the cat window centre
+        bool isNear(int px, int py)
+        {
+            int dx = px - (x + 16);
+            int dy = py - (y + 16);
+            return dx * dx + dy * dy < noticeDistance * noticeDistance;
+        }
+
     private:
         SDL_Renderer *renderer;
         SDL_Window* window;
         SDL_DisplayMode dm;
 
         SDL_Texture *texture;
-        SDL_Surface *image;
+        SDL_Texture *texture_left; // same atlas with every 32x32 frame mirrored
+
+        // mirroring once at startup spares a flipped copy per frame, which allocates in the software renderer
+        SDL_Texture* createMirroredTexture(SDL_Surface *image)
+        {
+            SDL_Surface *mirrored = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+            if (mirrored == NULL) {
+                SDL_Log("SDL_ConvertSurfaceFormat failed: %s", SDL_GetError());
+                return NULL;
+            }
+
+            SDL_LockSurface(mirrored);
+            for (int row = 0; row < mirrored->h; row++) {
+                Uint32 *pixels = (Uint32*) ((Uint8*) mirrored->pixels + row * mirrored->pitch);
+                for (int frame = 0; frame + 32 <= mirrored->w; frame += 32) {
+                    std::reverse(pixels + frame, pixels + frame + 32);
+                }
+            }
+            SDL_UnlockSurface(mirrored);
+
+            SDL_Texture *mirrored_texture = SDL_CreateTextureFromSurface(renderer, mirrored);
+            SDL_FreeSurface(mirrored);
+            return mirrored_texture;
+        }
 
         int sprite;
         int ticks;
@@ -249,38 +266,159 @@ class Cat
         int minimumWalkTime = 5;
         int minimumIdleTime = 5;
 
-        int actionDuration;
-        std::chrono::_V2::steady_clock::time_point start_action;
+        // distance in pixels at which the pointer wakes the cat
+        int noticeDistance = 96;
+
+        Uint32 start_action;
+
+        // seeded once so a recording replays the same decisions
+        std::mt19937 eng;
+        std::uniform_int_distribution<> distr;
 };
 
 class MySDLx11App : public SDLx11
 {
     public:
-        void init()
+        MySDLx11App() : record_path(NULL), replay_path(NULL), replay_speed(1.0), seed(0), arena(MAX_CATS * sizeof(Cat)), deadlines(MAX_CATS) {}
+
+        bool parseArgs(int argc, char** argv)
         {
-            SDL_Create("Cat", 0, 0, 32, 32, 0, false, 1.0f);
+            for (int i = 1; i < argc; i++)
+            {
+                if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+                    record_path = argv[++i];
+                }
+                else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+                    replay_path = argv[++i];
+                }
+                else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+                    replay_speed = atof(argv[++i]);
+                }
+                else {
+                    fprintf(stderr, "usage: %s [--record file] [--replay file [--speed factor, 0 = no wait]]\n", argv[0]);
+                    return false;
+                }
+            }
+            return true;
+        }
 
-            if (SDL_GetDesktopDisplayMode(0, &dm) != 0)
+        void init()
+        {
+            if (replay_path)
+            {
+                if (!player.open(replay_path, replay_speed))
+                    exit(1);
+
+                SDL_CreateHeadless(32, 32);
+                memset(&dm, 0, sizeof(dm));
+                dm.w = player.width();
+                dm.h = player.height();
+                seed = player.seed();
+            }
+            else
             {
-                SDL_Log("SDL_GetDesktopDisplayMode failed: %s", SDL_GetError());
-                return quit();
+                SDL_Create("Cat", 0, 0, 32, 32, 0, false, 1.0f);
+
+                if (SDL_GetDesktopDisplayMode(0, &dm) != 0)
+                {
+                    SDL_Log("SDL_GetDesktopDisplayMode failed: %s", SDL_GetError());
+                    return quit();
+                }
+
+                if (!SDL_SelectGlobalMotion())
+                    SDL_Log("XInput2 not available, the cat only notices the pointer over its window");
+
+                seed = std::random_device()();
+            }
+
+            if (record_path && !recorder.open(record_path, seed, dm.w, dm.h))
+                exit(1);
+        }
+
+        // next clock value for the frame, false when a replay is over
+        bool nextFrame(Uint32 *now)
+        {
+            if (replay_path) {
+                if (!player.nextFrame(now))
+                    return false;
             }
+            else {
+                *now = SDL_GetTicks();
+            }
+            recorder.frame(*now);
+            return true;
+        }
+
+        int pollEvent(SDL_Event *event)
+        {
+            int pending = replay_path ? player.pollEvent(event) : SDL_PollEvent(event);
+            if (pending)
+                recorder.event(event);
+            return pending;
+        }
+
+        // pointer position sampled at most once per frame, after the event queue is drained
+        bool getPointer(int *x, int *y)
+        {
+            bool moved = replay_path ? player.getPointer(x, y) : SDL_GetGlobalPointer(x, y);
+            if (moved)
+                recorder.pointer(*x, *y);
+            return moved;
         }
 
         void run()
         {
             SDL_Event event;
-            bool done = false;
+            Uint32 now;
+            int px, py;
 
             init();
 
-            Cat *cat = new Cat(renderer_, sdl_window_, dm);
+            unsigned long frames = 0;
+            bool done = !nextFrame(&now);
+
+            // indexed by DeadlineQueue id, the single SDLx11 window holds one cat for now
+            Cat *cats[MAX_CATS];
+            int cat_count = 1;
+
+            for (int id = 0; id < cat_count; id++)
+            {
+                cats[id] = arena.create<Cat>(renderer_, sdl_window_, dm, seed + id, now);
+
+                if (cats[id] == NULL)
+                {
+                    SDL_Log("Cat arena is full");
+                    return quit();
+                }
+
+                if (!cats[id]->loaded())
+                {
+                    for (int i = 0; i <= id; i++)
+                        arena.destroy(cats[i]);
+                    recorder.close();
+                    return quit();
+                }
+
+                deadlines.schedule(id, cats[id]->deadline());
+            }
 
             while (!done)
             {
-                cat->update();
+                for (int id; (id = deadlines.popExpired(now)) >= 0; ) {
+                    cats[id]->computeBehavior(now);
+                    deadlines.schedule(id, cats[id]->deadline());
+                }
+
+                bool any_asleep = false;
+
+                for (int id = 0; id < cat_count; id++) {
+                    cats[id]->update(now);
+                    any_asleep = any_asleep || cats[id]->getState() == State::IDLE5;
+                }
 
-                while (SDL_PollEvent(&event) != NULL)
+                bool pointer_over = false;
+
+                while (pollEvent(&event) != 0)
                 {
                     switch (event.type)
                     {
@@ -288,20 +426,60 @@ class MySDLx11App : public SDLx11
                             done = true;
                             break;
                         case SDL_MOUSEMOTION:
-                        {
-                            if (cat->getState() == State::IDLE5) {
-                                cat->setState(State::IDLE3);
-                            }
+                            // collapsed, a motion storm is handled once below
+                            pointer_over = true;
                             break;
-                        }
+                    }
+                }
+
+                bool sampled = any_asleep && getPointer(&px, &py);
+
+                for (int id = 0; id < cat_count; id++) {
+                    if (cats[id]->getState() == State::IDLE5 && (pointer_over || (sampled && cats[id]->isNear(px, py)))) {
+                        cats[id]->setState(State::IDLE3);
+                        deadlines.schedule(id, cats[id]->deadline());
                     }
                 }
 
                 SDL_RenderClear(renderer_);
-                cat->draw();
+                for (int id = 0; id < cat_count; id++) {
+                    cats[id]->draw();
+                }
                 SDL_RenderPresent(renderer_);
+
+                // nothing changes before the next deadline or sprite frame, a replay keeps its own pace
+                if (!done && !replay_path) {
+                    Uint32 ticks = SDL_GetTicks();
+                    Uint32 wait = SPEED;
+                    for (int id = 0; id < cat_count; id++) {
+                        wait = std::min(wait, cats[id]->idleFor(ticks));
+                    }
+                    wait = deadlines.timeUntil(ticks, wait);
+                    if (wait > 0)
+                        SDL_Delay(wait);
+                }
+
+                done = done || !nextFrame(&now);
+
+                if (++frames == WARMUP_FRAMES) {
+#ifdef ALLOC_GUARD
+                    SDL_Log("AllocGuard: %lu allocations during warm-up", AllocGuard::count());
+#endif
+                    AllocGuard::arm();
+                }
             }
 
+            AllocGuard::disarm();
+#ifdef ALLOC_GUARD
+            if (frames >= WARMUP_FRAMES)
+                SDL_Log("AllocGuard: no allocation in the %lu frames after warm-up", frames - WARMUP_FRAMES);
+            else
+                SDL_Log("AllocGuard: run ended during warm-up after %lu allocations", AllocGuard::count());
+#endif
+            for (int id = 0; id < cat_count; id++) {
+                arena.destroy(cats[id]);
+            }
+            recorder.close();
             quit();
         }
 
@@ -309,11 +487,27 @@ class MySDLx11App : public SDLx11
         {
             SDL_Destroy();
         }
+
+    private:
+        const char* record_path;
+        const char* replay_path;
+        double replay_speed;
+        Uint32 seed;
+
+        EventRecorder recorder;
+        EventPlayer player;
+
+        Arena arena;
+
+        // next action change of each cat, indexed by cat
+        DeadlineQueue deadlines;
 };
 
 int main(int argc, char** argv)
 {
     MySDLx11App app;
+    if (!app.parseArgs(argc, argv))
+        return 1;
     app.run();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "replay.hpp"
+#include <string.h>
+
+bool EventRecorder::open(const char *path, Uint32 seed, int w, int h)
+{
+    close();
+    file_ = fopen(path, "w");
+
+    if (file_ == NULL)
+    {
+        fprintf(stderr, "Could not open recording '%s'\n", path);
+        return false;
+    }
+
+    fprintf(file_, "cat-replay 1 %u %d %d\n", seed, w, h);
+    return true;
+}
+
+void EventRecorder::close()
+{
+    if (file_) fclose(file_);
+    file_ = NULL;
+}
+
+void EventRecorder::frame(Uint32 ticks)
+{
+    if (file_) fprintf(file_, "f %u\n", ticks);
+}
+
+void EventRecorder::event(const SDL_Event *e)
+{
+    if (!file_)
+        return;
+
+    switch (e->type)
+    {
+        case SDL_QUIT:
+            fprintf(file_, "q\n");
+            break;
+        case SDL_WINDOWEVENT:
+            if (e->window.event == SDL_WINDOWEVENT_CLOSE)
+                fprintf(file_, "c\n");
+            break;
+        case SDL_MOUSEMOTION:
+            fprintf(file_, "m %d %d\n", e->motion.x, e->motion.y);
+            break;
+        case SDL_MOUSEWHEEL:
+            fprintf(file_, "w %d %d\n", e->wheel.x, e->wheel.y);
+            break;
+        // other events do not change the cat and are not recorded
+    }
+}
+
+void EventRecorder::pointer(int x, int y)
+{
+    if (file_) fprintf(file_, "p %d %d\n", x, y);
+}
+
+bool EventPlayer::open(const char *path, double speed)
+{
+    close();
+    file_ = fopen(path, "r");
+
+    if (file_ == NULL)
+    {
+        fprintf(stderr, "Could not open recording '%s'\n", path);
+        return false;
+    }
+
+    int version = 0;
+    if (!readLine() || sscanf(line_, "cat-replay %d %u %d %d", &version, &seed_, &w_, &h_) != 4 || version != 1)
+    {
+        fprintf(stderr, "'%s' is not a cat recording\n", path);
+        close();
+        return false;
+    }
+
+    has_pending_ = readLine();
+    has_pointer_ = false;
+    speed_ = speed;
+    started_ = false;
+    return true;
+}
+
+void EventPlayer::close()
+{
+    if (file_) fclose(file_);
+    file_ = NULL;
+    has_pending_ = false;
+}
+
+bool EventPlayer::readLine()
+{
+    return file_ && fgets(line_, sizeof(line_), file_) != NULL;
+}
+
+bool EventPlayer::nextFrame(Uint32 *ticks)
+{
+    // skip events the frame loop did not poll
+    while (has_pending_ && line_[0] != 'f')
+        has_pending_ = readLine();
+
+    if (!has_pending_ || sscanf(line_, "f %u", ticks) != 1)
+        return false;
+
+    has_pending_ = readLine();
+
+    if (!started_)
+    {
+        first_ticks_ = *ticks;
+        start_real_ = SDL_GetTicks();
+        started_ = true;
+    }
+
+    if (speed_ > 0)
+    {   // keep the recorded pace, scaled by speed
+        Uint32 due = start_real_ + (Uint32)((*ticks - first_ticks_) / speed_);
+        Uint32 now = SDL_GetTicks();
+        if (!SDL_TICKS_PASSED(now, due))
+            SDL_Delay(due - now);
+    }
+
+    return true;
+}
+
+int EventPlayer::pollEvent(SDL_Event *e)
+{
+    while (has_pending_ && line_[0] != 'f')
+    {
+        memset(e, 0, sizeof(SDL_Event));
+        bool ok = true;
+
+        switch (line_[0])
+        {
+            case 'q':
+                e->type = SDL_QUIT;
+                break;
+            case 'c':
+                e->type = SDL_WINDOWEVENT;
+                e->window.event = SDL_WINDOWEVENT_CLOSE;
+                break;
+            case 'm':
+                e->type = SDL_MOUSEMOTION;
+                ok = sscanf(line_, "m %d %d", &e->motion.x, &e->motion.y) == 2;
+                break;
+            case 'w':
+                e->type = SDL_MOUSEWHEEL;
+                ok = sscanf(line_, "w %d %d", &e->wheel.x, &e->wheel.y) == 2;
+                break;
+            case 'p':
+                // not an SDL event, kept for getPointer
+                has_pointer_ = sscanf(line_, "p %d %d", &pointer_x_, &pointer_y_) == 2;
+                ok = false;
+                break;
+            default:
+                ok = false;
+        }
+
+        has_pending_ = readLine();
+        if (ok)
+            return 1;
+    }
+
+    return 0;
+}
+
+bool EventPlayer::getPointer(int *x, int *y)
+{
+    if (!has_pointer_)
+        return false;
+
+    has_pointer_ = false;
+    *x = pointer_x_;
+    *y = pointer_y_;
+    return true;
+}
@@ -0,0 +1,73 @@
+/*
+*  Record and replay of the translated SDL events seen by the frame loop.
+*  A recording lets a run be fed back with --replay under the headless driver, so the cat goes
+*  through the exact same state sequence and frame-time/CPU profiles can be compared between builds.
+*
+*  The file is plain text, one entry per line:
+*    cat-replay 1 <seed> <display w> <display h>    header, RNG seed and desktop size
+*    f <ticks>                                      start of a frame, clock in ms
+*    q                                              SDL_QUIT
+*    c                                              SDL_WINDOWEVENT_CLOSE
+*    m <x> <y>                                      SDL_MOUSEMOTION
+*    w <x> <y>                                      SDL_MOUSEWHEEL
+*    p <x> <y>                                      global pointer sample of the frame
+*  Events belong to the last frame line above them.
+*/
+#pragma once
+#include <stdio.h>
+#include <SDL2/SDL.h>
+
+class EventRecorder
+{
+public:
+    EventRecorder() : file_(NULL) {}
+    ~EventRecorder() { close(); }
+
+    bool open(const char *path, Uint32 seed, int w, int h);
+    void close();
+
+    // all of these are no-ops while no file is open
+    void frame(Uint32 ticks);
+    void event(const SDL_Event *e);
+    void pointer(int x, int y);
+
+private:
+    FILE* file_;
+};
+
+class EventPlayer
+{
+public:
+    EventPlayer() : file_(NULL), seed_(0), w_(0), h_(0), speed_(1.0), first_ticks_(0), start_real_(0), started_(false), has_pending_(false), has_pointer_(false), pointer_x_(0), pointer_y_(0) {}
+    ~EventPlayer() { close(); }
+
+    // speed scales the recorded time, 0 replays as fast as possible
+    bool open(const char *path, double speed);
+    void close();
+
+    Uint32 seed() const { return seed_; }
+    int width() const { return w_; }
+    int height() const { return h_; }
+
+    // wait for and enter the next recorded frame, returns false at the end of the recording
+    bool nextFrame(Uint32 *ticks);
+    // same contract as SDL_PollEvent, for the events of the current frame
+    int pollEvent(SDL_Event *e);
+    // same contract as SDLx11::SDL_GetGlobalPointer, valid once pollEvent returned 0
+    bool getPointer(int *x, int *y);
+
+private:
+    bool readLine();
+
+    FILE*  file_;
+    Uint32 seed_;
+    int    w_, h_;
+    double speed_;
+    Uint32 first_ticks_;
+    Uint32 start_real_;
+    bool   started_;
+    bool   has_pending_;
+    bool   has_pointer_;
+    int    pointer_x_, pointer_y_;
+    char   line_[64];
+};
@@ -2,6 +2,7 @@
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <X11/extensions/Xrender.h>
+#include <X11/extensions/XInput2.h>
 #include <GL/glx.h>
 #include <SDL2/SDL.h>
 
@@ -217,14 +218,48 @@ SDLx11::SDL_Create(const char *title, int x, int y, int w, int h, Uint32 render_
     return renderer_;
 }
 
+SDL_Renderer*
+SDLx11::SDL_CreateHeadless(int w, int h)
+{
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    {
+        fprintf(stderr, "SDL error SDL_Init: %s\n", SDL_GetError());
+        exit(1);
+    }
+
+    // a real window so moving it costs what it costs in a live run
+    sdl_window_ = SDL_CreateWindow("Cat", 0, 0, w, h, SDL_WINDOW_BORDERLESS);
+
+    if (sdl_window_ == NULL)
+    {
+        fprintf(stderr, "SDL error SDL_CreateWindow: %s\n", SDL_GetError());
+        exit(1);
+    }
+
+    renderer_ = SDL_CreateRenderer(sdl_window_, -1, SDL_RENDERER_SOFTWARE);
+
+    if (renderer_ == NULL)
+    {
+        fprintf(stderr, "SDL error SDL_CreateRenderer: %s\n", SDL_GetError());
+        exit(1);
+    }
+
+    return renderer_;
+}
+
 void SDLx11::SDL_Destroy()
 {
     if (renderer_)  SDL_DestroyRenderer(renderer_);
+    if (sdl_window_ && !xwindow_) SDL_DestroyWindow(sdl_window_); // headless, not wrapping an X window
     if (xwindow_)   XDestroyWindow(xdisplay_, (Window) xwindow_);
     if (xdisplay_)  XCloseDisplay(xdisplay_);
     
     xdisplay_   = NULL;
     xwindow_    = 0;
+    xi_opcode_  = 0;
+    pointer_moved_ = false;
     renderer_   = NULL;
     sdl_window_ = NULL;
 }
@@ -237,6 +272,14 @@ int SDLx11::SDL_PollEvent(SDL_Event* e)
         XEvent event;
         XNextEvent(xdisplay_, &event);
 
+        // raw motion only marks the pointer as moved, see SDL_GetGlobalPointer
+        if (event.type == GenericEvent && xi_opcode_ && event.xcookie.extension == xi_opcode_)
+        {
+            if (event.xcookie.evtype == XI_RawMotion)
+                pointer_moved_ = true;
+            continue;
+        }
+
         // handle mouse button and wheel events and pass them SDL
         if (event.type==ButtonPress || event.type==ButtonRelease)
         {
@@ -294,4 +337,49 @@ int SDLx11::SDL_PollEvent(SDL_Event* e)
 
     // call and return SDLs SDL_PollEvent for the other events
     return ::SDL_PollEvent(e);
-}
\ No newline at end of file
+}
+
+bool SDLx11::SDL_SelectGlobalMotion()
+{
+    int event, error;
+
+    if (!xdisplay_ || !XQueryExtension(xdisplay_, "XInputExtension", &xi_opcode_, &event, &error))
+    {
+        xi_opcode_ = 0;
+        return false;
+    }
+
+    int major = 2, minor = 0;
+    if (XIQueryVersion(xdisplay_, &major, &minor) != Success)
+    {
+        xi_opcode_ = 0;
+        return false;
+    }
+
+    unsigned char mask[XIMaskLen(XI_RawMotion)] = { 0 };
+    XIEventMask evmask;
+    evmask.deviceid = XIAllMasterDevices;
+    evmask.mask_len = sizeof(mask);
+    evmask.mask = mask;
+    XISetMask(mask, XI_RawMotion);
+
+    XISelectEvents(xdisplay_, DefaultRootWindow(xdisplay_), &evmask, 1);
+    XFlush(xdisplay_);
+
+    // report the initial position on the first query
+    pointer_moved_ = true;
+    return true;
+}
+
+bool SDLx11::SDL_GetGlobalPointer(int *x, int *y)
+{
+    if (!pointer_moved_)
+        return false;
+
+    pointer_moved_ = false;
+
+    Window root, child;
+    int win_x, win_y;
+    unsigned int buttons;
+    return XQueryPointer(xdisplay_, DefaultRootWindow(xdisplay_), &root, &child, x, y, &win_x, &win_y, &buttons);
+}
@@ -87,9 +87,11 @@ protected:
     SDL_Window*   sdl_window_;
     SDL_SysWMinfo sdlSysWMinfo_; // get access to SDLs xdisplay
     SDL_DisplayMode dm;
+    int           xi_opcode_;        // XInput2 extension opcode, 0 if raw motion is not selected
+    bool          pointer_moved_;    // XI_RawMotion seen since the last SDL_GetGlobalPointer
 
 public:
-    SDLx11() : xdisplay_(NULL), xwindow_(0), renderer_(NULL), sdl_window_(NULL) 
+    SDLx11() : xdisplay_(NULL), xwindow_(0), renderer_(NULL), sdl_window_(NULL), xi_opcode_(0), pointer_moved_(false) 
         { memset(&sdlSysWMinfo_, 0, sizeof(SDL_SysWMinfo)); }
     virtual ~SDLx11() { SDL_Destroy(); }
 
@@ -110,7 +112,21 @@ public:
         bool fullscreen = false, 
         double frame_alpha = 1.0);
 
+    // create window & software renderer on the dummy video driver, no X server needed
+    SDL_Renderer*
+    SDL_CreateHeadless(int w, int h);
+
     void SDL_Destroy();
 
     int SDL_PollEvent(SDL_Event*);
+
+    // subscribe to XInput2 raw motion on the root window to follow the pointer outside our window,
+    // returns false if the X server has no XInput 2.0
+    bool SDL_SelectGlobalMotion();
+
+    // latest pointer position in root coordinates, false if it did not move since the last call.
+    // Raw motion events handled by SDL_PollEvent only set a flag, the position costs one blocking
+    // XQueryPointer round trip here, so call it only when the position matters.
+    // Each XI_RawMotion still has its cookie malloc'ed by Xlib in XNextEvent and freed on the next call.
+    bool SDL_GetGlobalPointer(int *x, int *y);
 };
\ No newline at end of file